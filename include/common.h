@@ -70,6 +70,15 @@ typedef struct {
 
     // Última alerta
     char last_alert[128];
+
+    // Contadores para exportar métricas (solo se incrementan, con __sync_*)
+    unsigned long dispatch_loops;     // iteraciones del bucle de despacho
+    unsigned long orders_dispatched;  // órdenes asignadas a una banda
+    unsigned long blocked_missing;    // despacho pasó a bloqueado: falta ingrediente en todas las bandas
+    unsigned long blocked_waiting;    // despacho pasó a bloqueado: bandas ocupadas/pausadas/sin suficiente
+    unsigned long orders_returned;    // devueltas por un worker a la cola global
+    unsigned long alerts_raised;      // alertas nuevas (no cuenta reintentos de la misma)
+    int dispatch_blocked;             // 1 mientras el despacho esté detenido por una orden
 } SharedState;
 
 // Utilidades comunes
@@ -77,14 +86,22 @@ int can_band_fulfill(const BandStatus *b, const Order *o);
 void consume_inventory(BandStatus *b, const Order *o);
 int can_band_fulfill_locked(BandStatus *b, const Order *o);
 void consume_inventory_locked(BandStatus *b, const Order *o);
-void queue_init(OrderQueue *q, int capacity);
+void queue_init(OrderQueue *q, int capacity, int pshared);
 void queue_destroy(OrderQueue *q);
 int queue_push(OrderQueue *q, const Order *o, int capacity, int block);
 int queue_pop(OrderQueue *q, Order *o, int capacity, int block);
+int queue_push_many(OrderQueue *q, const Order *os, int n, int capacity, int block);
 
-void bqueue_init(BandQueue *q, int capacity);
+void bqueue_init(BandQueue *q, int capacity, int pshared);
 void bqueue_destroy(BandQueue *q);
 int bqueue_push(BandQueue *q, const Order *o, int capacity, int block);
 int bqueue_pop(BandQueue *q, Order *o, int capacity, int block);
 
+// Lógica compartida por el manager y el simulador
+int parse_inventory(const char *s, int out[MAX_ING]);
+void state_init(SharedState *st, int n_bands, const int inv[MAX_ING], int pshared);
+void state_destroy(SharedState *st);
+int dispatch_pending(SharedState *st, int *blocked);
+int band_claim_order(SharedState *st, BandStatus *b, const Order *o, int block);
+
 #endif // COMMON_H
@@ -1,6 +1,9 @@
 #define _GNU_SOURCE
 #include "../include/common.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 
 const char *ING_NAMES[MAX_ING] = {
     "pan", "tomate", "cebolla", "lechuga", "queso", "carne"
@@ -38,12 +41,12 @@ static void queue_reset(OrderQueue *q) {
     q->head = q->tail = q->count = 0;
 }
 
-void queue_init(OrderQueue *q, int capacity) {
+void queue_init(OrderQueue *q, int capacity, int pshared) {
     (void)capacity;
     queue_reset(q);
-    sem_init(&q->mutex, 1, 1);
-    sem_init(&q->items, 1, 0);
-    sem_init(&q->spaces, 1, MAX_ORDERS);
+    sem_init(&q->mutex, pshared, 1);
+    sem_init(&q->items, pshared, 0);
+    sem_init(&q->spaces, pshared, MAX_ORDERS);
 }
 
 void queue_destroy(OrderQueue *q) {
@@ -78,16 +81,36 @@ int queue_pop(OrderQueue *q, Order *o, int capacity, int block) {
     return 0;
 }
 
+// Encola hasta n ordenes tomando el mutex una sola vez. Si block, espera solo
+// hasta que haya al menos un espacio libre; devuelve cuantas se encolaron.
+int queue_push_many(OrderQueue *q, const Order *os, int n, int capacity, int block) {
+    int got = 0;
+    if (n <= 0) return 0;
+    if (block) { sem_wait(&q->spaces); got = 1; }
+    while (got < n && sem_trywait(&q->spaces) == 0) got++;
+    if (got == 0) return 0;
+
+    sem_wait(&q->mutex);
+    for (int i = 0; i < got; ++i) {
+        q->buf[q->tail] = os[i];
+        q->tail = (q->tail + 1) % capacity;
+    }
+    q->count += got;
+    sem_post(&q->mutex);
+    for (int i = 0; i < got; ++i) sem_post(&q->items);
+    return got;
+}
+
 static void bqueue_reset(BandQueue *q) {
     q->head = q->tail = q->count = 0;
 }
 
-void bqueue_init(BandQueue *q, int capacity) {
+void bqueue_init(BandQueue *q, int capacity, int pshared) {
     (void)capacity;
     bqueue_reset(q);
-    sem_init(&q->mutex, 1, 1);
-    sem_init(&q->items, 1, 0);
-    sem_init(&q->spaces, 1, MAX_PER_BAND_QUEUE);
+    sem_init(&q->mutex, pshared, 1);
+    sem_init(&q->items, pshared, 0);
+    sem_init(&q->spaces, pshared, MAX_PER_BAND_QUEUE);
 }
 
 void bqueue_destroy(BandQueue *q) {
@@ -121,3 +144,160 @@ int bqueue_pop(BandQueue *q, Order *o, int capacity, int block) {
     sem_post(&q->spaces);
     return 0;
 }
+
+// Parsea "a,b,c,d,e,f" (coma y/o espacio). Devuelve 0 si hay MAX_ING enteros >= 0
+int parse_inventory(const char *s, int out[MAX_ING]) {
+    int vals[MAX_ING]; int cnt = 0;
+    char tmp[128];
+    strncpy(tmp, s, sizeof(tmp)-1); tmp[sizeof(tmp)-1] = '\0';
+    char *save = NULL;
+    char *tok = strtok_r(tmp, ", ", &save);
+    while (tok && cnt < MAX_ING) {
+        char *end = NULL; errno = 0; long v = strtol(tok, &end, 10);
+        if (errno || end == tok || *end != '\0' || v < 0) return -1;
+        vals[cnt++] = (int)v;
+        tok = strtok_r(NULL, ", ", &save);
+    }
+    if (cnt != MAX_ING) return -1;
+    for (int k = 0; k < MAX_ING; ++k) out[k] = vals[k];
+    return 0;
+}
+
+// pshared=1 para la shm del manager (semáforos entre procesos); 0 para un
+// estado privado de un solo proceso, como el del simulador
+void state_init(SharedState *st, int n_bands, const int inv[MAX_ING], int pshared) {
+    memset(st, 0, sizeof(*st));
+    st->n_bands = n_bands;
+    st->shutting_down = 0;
+    st->next_order_id = 1;
+    queue_init(&st->orders, MAX_ORDERS, pshared);
+    sem_init(&st->inv_update, pshared, 0);
+
+    for (int i = 0; i < n_bands; ++i) {
+        BandStatus *b = &st->bands[i];
+        b->id = i;
+        b->running = 1;
+        b->processed = 0;
+        b->busy = 0;
+        for (int k = 0; k < MAX_ING; ++k) b->inv[k] = inv[k];
+        bqueue_init(&b->q, MAX_PER_BAND_QUEUE, pshared);
+        sem_init(&b->band_mutex, pshared, 1);
+    }
+}
+
+void state_destroy(SharedState *st) {
+    for (int i = 0; i < st->n_bands; ++i) {
+        bqueue_destroy(&st->bands[i].q);
+        sem_destroy(&st->bands[i].band_mutex);
+    }
+    queue_destroy(&st->orders);
+    sem_destroy(&st->inv_update);
+}
+
+// Escribe la alerta y la cuenta solo si cambió respecto a la actual
+static void raise_alert(SharedState *st, const char *msg) {
+    if (strcmp(st->last_alert, msg) == 0) return;
+    snprintf(st->last_alert, sizeof(st->last_alert), "%s", msg);
+    __sync_fetch_and_add(&st->alerts_raised, 1);
+}
+
+// Reparte la cola global entre las bandas: cada orden va a la banda activa con
+// menor cola que pueda cumplirla. La primera orden no asignable se re-encola,
+// se deja una alerta y se corta el reparto (*blocked = 1). Los contadores de
+// bloqueo y de alertas solo avanzan al pasar de no bloqueado a bloqueado, no
+// en cada reintento; asignar cualquier orden cuenta como volver a fluir.
+// Devuelve cuántas órdenes se asignaron.
+int dispatch_pending(SharedState *st, int *blocked) {
+    Order cur;
+    int processed_orders = 0;
+    *blocked = 0;
+    while (queue_pop(&st->orders, &cur, MAX_ORDERS, 0) == 0) {
+        int assigned = 0;
+
+        // Estrategia: buscar la banda con menos carga primero
+        int best_band = -1;
+        int min_queue = MAX_PER_BAND_QUEUE + 1;
+
+        for (int i = 0; i < st->n_bands; ++i) {
+            BandStatus *b = &st->bands[i];
+            if (!b->running) continue; // banda pausada
+
+            // Verificar inventario
+            if (!can_band_fulfill_locked(b, &cur)) continue;
+
+            // Encontrar banda con menor cola
+            sem_wait(&b->q.mutex);
+            int queue_size = b->q.count;
+            sem_post(&b->q.mutex);
+
+            if (queue_size < min_queue) {
+                min_queue = queue_size;
+                best_band = i;
+            }
+        }
+
+        if (best_band >= 0) {
+            BandStatus *b = &st->bands[best_band];
+            if (bqueue_push(&b->q, &cur, MAX_PER_BAND_QUEUE, 0) == 0) {
+                assigned = 1;
+                processed_orders++;
+                __sync_fetch_and_add(&st->orders_dispatched, 1);
+                // Limpiar alerta cuando se asigna exitosamente
+                if (processed_orders == 1) {
+                    st->last_alert[0] = '\0';
+                    st->dispatch_blocked = 0;
+                }
+            }
+        }
+
+        if (!assigned) {
+            // no hay banda con inventario: re-encolar y alertar
+            queue_push(&st->orders, &cur, MAX_ORDERS, 1);
+            // detectar ingrediente faltante más significativo
+            int missingIdx = -1;
+            for (int k = 0; k < MAX_ING; ++k) {
+                if (cur.ing[k] == 0) continue;
+                int any = 0;
+                for (int i = 0; i < st->n_bands; ++i) {
+                    BandStatus *b = &st->bands[i];
+                    sem_wait(&b->band_mutex);
+                    int has_ingredient = (b->inv[k] > 0);
+                    sem_post(&b->band_mutex);
+                    if (has_ingredient) { any = 1; break; }
+                }
+                if (!any) { missingIdx = k; break; }
+            }
+            if (missingIdx >= 0)
+                snprintf(st->last_alert, sizeof(st->last_alert),
+                         "Orden %d bloqueada: falta %s en todas las bandas", cur.id, ING_NAMES[missingIdx]);
+            else
+                snprintf(st->last_alert, sizeof(st->last_alert),
+                         "Orden %d en espera: bandas ocupadas o sin inventario suficiente", cur.id);
+            if (!st->dispatch_blocked) {
+                st->dispatch_blocked = 1;
+                __sync_fetch_and_add(missingIdx >= 0 ? &st->blocked_missing : &st->blocked_waiting, 1);
+                __sync_fetch_and_add(&st->alerts_raised, 1);
+            }
+            *blocked = 1;
+            break; // esperar restock o que se liberen bandas
+        }
+    }
+    if (!*blocked) st->dispatch_blocked = 0;
+    return processed_orders;
+}
+
+// Paso del worker tras sacar una orden de su cola: consume inventario si
+// alcanza (1); si no, la devuelve a la cola global con alerta (0). Con
+// block=0 y la cola global llena devuelve -1 y el llamador conserva la orden.
+int band_claim_order(SharedState *st, BandStatus *b, const Order *o, int block) {
+    if (can_band_fulfill_locked(b, o)) {
+        consume_inventory_locked(b, o);
+        return 1;
+    }
+    if (queue_push(&st->orders, o, MAX_ORDERS, block) != 0) return -1;
+    char msg[sizeof(st->last_alert)];
+    snprintf(msg, sizeof(msg), "Banda %d sin ingredientes para orden %d", b->id, o->id);
+    raise_alert(st, msg);
+    __sync_fetch_and_add(&st->orders_returned, 1);
+    return 0;
+}
@@ -6,21 +6,46 @@
 #include <sys/mman.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <limits.h>
 #include "../include/common.h"
 
+// Tamaño maximo de un lote de ordenes en modo batch (se envia con un solo lock)
+#define BATCH_MAX_ORDERS 64
+// Comandos pendientes de reportar antes de forzar un flush
+#define BATCH_MAX_RESULTS 256
+
+typedef enum {
+    CMD_EMPTY, CMD_QUIT, CMD_HELP, CMD_PAUSE, CMD_RESUME,
+    CMD_GEN, CMD_ORD, CMD_INV, CMD_BAD
+} CmdType;
+
+typedef struct {
+    CmdType type;
+    int a, b, c;               // banda / N / ingrediente / valor segun comando
+    int ing[MAX_ING];          // solo CMD_ORD
+    const char *err;           // mensaje si CMD_BAD
+} Cmd;
+
 static void trim(char *s) {
     size_t n = strlen(s);
     while (n && (s[n-1] == '\n' || s[n-1] == '\r' || isspace((unsigned char)s[n-1]))) s[--n] = '\0';
     char *p = s; while (*p && isspace((unsigned char)*p)) ++p; if (p != s) memmove(s, p, strlen(p)+1);
 }
 
-static void make_random_order(SharedState *st, Order *o) {
-    o->id = __sync_fetch_and_add(&st->next_order_id, 1);
+// Receta aleatoria compartida por gen interactivo y batch
+static void fill_random_ingredients(Order *o) {
     for (int i = 0; i < MAX_ING; ++i) o->ing[i] = (rand() % 2);
     o->ing[0] = 1; // pan
     o->ing[5] = 1; // carne
 }
 
+static void make_random_order(SharedState *st, Order *o) {
+    o->id = __sync_fetch_and_add(&st->next_order_id, 1);
+    fill_random_ingredients(o);
+}
+
 static void print_help(void) {
     printf("Comandos:\n");
     printf("  p i       -> pausar banda i\n");
@@ -31,14 +56,52 @@ static void print_help(void) {
     printf("  q         -> salir\n");
 }
 
-int main(void) {
-    // Abrir shm creada por manager
-    int fd = shm_open(SHM_NAME, O_RDWR, 0600);
-    if (fd < 0) { perror("shm_open"); return 1; }
-    SharedState *st = mmap(NULL, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (st == MAP_FAILED) { perror("mmap"); return 1; }
-    close(fd);
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [-b] [archivo]\n", prog);
+    fprintf(stderr, "  -b         Modo batch: lee comandos de stdin sin prompt\n");
+    fprintf(stderr, "  archivo    Script de comandos (implica -b)\n");
+}
+
+// Interpreta una linea ya recortada; valida formato y rangos
+static void parse_command(const char *line, const SharedState *st, Cmd *c) {
+    int n_bands = st->n_bands;
+    memset(c, 0, sizeof(*c));
+    if (!*line) { c->type = CMD_EMPTY; return; }
+
+    if (strcmp(line, "q") == 0 || strcmp(line, "quit") == 0 || strcmp(line, "exit") == 0) {
+        c->type = CMD_QUIT;
+    } else if (strcmp(line, "help") == 0 || strcmp(line, "h") == 0) {
+        c->type = CMD_HELP;
+    } else if ((line[0] == 'p' || line[0] == 'r') && isspace((unsigned char)line[1])) {
+        c->type = line[0] == 'p' ? CMD_PAUSE : CMD_RESUME;
+        c->a = atoi(&line[2]);
+        if (c->a < 0 || c->a >= n_bands) { c->type = CMD_BAD; c->err = "Indice fuera de rango"; }
+    } else if (strncmp(line, "gen ", 4) == 0) {
+        c->type = CMD_GEN;
+        c->a = atoi(&line[4]);
+        if (c->a <= 0) { c->type = CMD_BAD; c->err = "N invalido"; }
+        else if (c->a > INT_MAX - st->next_order_id) { c->type = CMD_BAD; c->err = "N excede los ids de orden disponibles"; }
+    } else if (strncmp(line, "ord ", 4) == 0) {
+        int *v = c->ing;
+        c->type = CMD_ORD;
+        if (sscanf(line+4, "%d %d %d %d %d %d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) == 6) {
+            for (int i = 0; i < MAX_ING; ++i) v[i] = v[i] ? 1 : 0;
+        } else {
+            c->type = CMD_BAD; c->err = "Formato: ord a b c d e f (0/1)";
+        }
+    } else if (strncmp(line, "inv ", 4) == 0) {
+        c->type = CMD_INV;
+        if (sscanf(line+4, "%d %d %d", &c->a, &c->b, &c->c) != 3) {
+            c->type = CMD_BAD; c->err = "Formato: inv b k val";
+        } else if (c->a < 0 || c->a >= n_bands || c->b < 0 || c->b >= MAX_ING) {
+            c->type = CMD_BAD; c->err = "Indices fuera de rango";
+        }
+    } else {
+        c->type = CMD_BAD; c->err = "Comando no reconocido. Escribe 'help'.";
+    }
+}
 
+static void run_interactive(SharedState *st) {
     // Prompts visibles
     setvbuf(stdout, NULL, _IONBF, 0);
     printf("Controller listo. Escribe 'help' para ayuda.\n");
@@ -49,83 +112,371 @@ int main(void) {
         printf("controller> ");
         if (!fgets(line, sizeof(line), stdin)) break; // EOF/Ctrl+D
         trim(line);
-        if (!*line) continue;
 
-        if (strcmp(line, "q") == 0 || strcmp(line, "quit") == 0 || strcmp(line, "exit") == 0) {
-            break;
-        } else if (strcmp(line, "help") == 0 || strcmp(line, "h") == 0) {
-            print_help();
-        } else if (line[0] == 'p' && isspace((unsigned char)line[1])) {
-            int idx = atoi(&line[2]);
-            if (idx >= 0 && idx < st->n_bands) {
-                sem_wait(&st->bands[idx].band_mutex);
-                st->bands[idx].running = 0;
-                sem_post(&st->bands[idx].band_mutex);
-                sem_post(&st->inv_update);
-                printf("Banda %d pausada\n", idx);
-            } else {
-                printf("Indice fuera de rango\n");
-            }
-        } else if (line[0] == 'r' && isspace((unsigned char)line[1])) {
-            int idx = atoi(&line[2]);
-            if (idx >= 0 && idx < st->n_bands) {
-                sem_wait(&st->bands[idx].band_mutex);
-                st->bands[idx].running = 1;
-                sem_post(&st->bands[idx].band_mutex);
+        Cmd c;
+        parse_command(line, st, &c);
+        if (c.type == CMD_EMPTY) continue;
+        if (c.type == CMD_QUIT) break;
+
+        switch (c.type) {
+            case CMD_HELP:
+                print_help();
+                break;
+            case CMD_PAUSE:
+            case CMD_RESUME:
+                sem_wait(&st->bands[c.a].band_mutex);
+                st->bands[c.a].running = (c.type == CMD_RESUME);
+                sem_post(&st->bands[c.a].band_mutex);
                 sem_post(&st->inv_update);
-                printf("Banda %d reanudada\n", idx);
-            } else {
-                printf("Indice fuera de rango\n");
-            }
-        } else if (strncmp(line, "gen ", 4) == 0) {
-            int n = atoi(&line[4]);
-            if (n <= 0) { printf("N invalido\n"); continue; }
-            for (int i = 0; i < n; ++i) {
-                Order o; make_random_order(st, &o);
-                if (queue_push(&st->orders, &o, MAX_ORDERS, 1) != 0) {
-                    printf("Cola llena; reintenta\n");
-                    break;
+                printf("Banda %d %s\n", c.a, c.type == CMD_RESUME ? "reanudada" : "pausada");
+                break;
+            case CMD_GEN:
+                for (int i = 0; i < c.a; ++i) {
+                    Order o; make_random_order(st, &o);
+                    if (queue_push(&st->orders, &o, MAX_ORDERS, 1) != 0) {
+                        printf("Cola llena; reintenta\n");
+                        break;
+                    }
+                    if (last_count < (int)(sizeof(last_ids)/sizeof(last_ids[0]))) last_ids[last_count++] = o.id;
                 }
-                if (last_count < (int)(sizeof(last_ids)/sizeof(last_ids[0]))) last_ids[last_count++] = o.id;
-            }
-            sem_post(&st->inv_update);
-            printf("Generadas %d ordenes. IDs:", n);
-            for (int i = 0; i < last_count; ++i) printf(" %d", last_ids[i]);
-            printf("\n");
-            last_count = 0;
-        } else if (strncmp(line, "ord ", 4) == 0) {
-            int v[MAX_ING] = {0};
-            if (sscanf(line+4, "%d %d %d %d %d %d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) == 6) {
+                sem_post(&st->inv_update);
+                printf("Generadas %d ordenes. IDs:", c.a);
+                for (int i = 0; i < last_count; ++i) printf(" %d", last_ids[i]);
+                printf("\n");
+                last_count = 0;
+                break;
+            case CMD_ORD: {
                 Order o = {0};
                 o.id = __sync_fetch_and_add(&st->next_order_id, 1);
-                for (int i = 0; i < MAX_ING; ++i) o.ing[i] = v[i] ? 1 : 0;
+                for (int i = 0; i < MAX_ING; ++i) o.ing[i] = c.ing[i];
                 if (queue_push(&st->orders, &o, MAX_ORDERS, 1) == 0) {
                     sem_post(&st->inv_update);
                     printf("Orden %d encolada\n", o.id);
                 } else {
                     printf("No se pudo encolar la orden\n");
                 }
-            } else {
-                printf("Formato: ord a b c d e f (0/1)\n");
-            }
-    } else if (strncmp(line, "inv ", 4) == 0) {
-            int b, k, val;
-            if (sscanf(line+4, "%d %d %d", &b, &k, &val) == 3) {
-                if (b >=0 && b < st->n_bands && k >=0 && k < MAX_ING) {
-            sem_wait(&st->bands[b].band_mutex);
-            st->bands[b].inv[k] = val;
-            sem_post(&st->bands[b].band_mutex);
-                    sem_post(&st->inv_update);
-                    printf("Inventario banda %d ingrediente %d -> %d\n", b, k, val);
-                } else {
-                    printf("Indices fuera de rango\n");
-                }
-            } else {
-                printf("Formato: inv b k val\n");
+                break;
             }
+            case CMD_INV:
+                sem_wait(&st->bands[c.a].band_mutex);
+                st->bands[c.a].inv[c.b] = c.c;
+                sem_post(&st->bands[c.a].band_mutex);
+                sem_post(&st->inv_update);
+                printf("Inventario banda %d ingrediente %d -> %d\n", c.a, c.b, c.c);
+                break;
+            default:
+                printf("%s\n", c.err);
+                break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Modo batch: los comandos consecutivos del mismo grupo se acumulan y se
+// aplican juntos. p/r/inv se fusionan en una sola toma de band_mutex por
+// banda; gen/ord se encolan en bloque. Cada comando produce una linea JSON
+// en stdout cuando su grupo se aplica: al cambiar de grupo, al llenarse el
+// lote, al final de la entrada o cuando la entrada queda sin datos.
+
+typedef struct {
+    int line;                  // numero de linea en el script
+    CmdType type;
+    int a, b, c;
+    int first_id, last_id;     // ids asignados al encolar (gen/ord)
+    int queued;                // ordenes realmente encoladas (gen/ord)
+    const char *err;           // motivo si no se encolaron todas
+} BatchResult;
+
+typedef struct {
+    SharedState *st;
+    int group;                 // 0 = vacio, 1 = bandas, 2 = ordenes
+    int running[MAX_BANDS];
+    int inv[MAX_BANDS][MAX_ING];
+    int run_set[MAX_BANDS];           // 1 si running[i] tiene un cambio pendiente
+    unsigned inv_set[MAX_BANDS];      // bit k: inv[i][k] tiene un cambio pendiente
+    Order orders[BATCH_MAX_ORDERS];
+    int order_res[BATCH_MAX_ORDERS];  // indice en res de cada orden
+    int n_orders;
+    BatchResult res[BATCH_MAX_RESULTS];
+    int n_res;
+    long n_ok, n_err, n_submitted;
+} Batch;
+
+static const char *cmd_name(CmdType t) {
+    switch (t) {
+        case CMD_PAUSE: return "p";
+        case CMD_RESUME: return "r";
+        case CMD_GEN: return "gen";
+        case CMD_ORD: return "ord";
+        case CMD_INV: return "inv";
+        case CMD_HELP: return "help";
+        default: return "?";
+    }
+}
+
+static void batch_reset_bands(Batch *bt) {
+    memset(bt->run_set, 0, sizeof(bt->run_set));
+    memset(bt->inv_set, 0, sizeof(bt->inv_set));
+}
+
+// Reserva n ids consecutivos sin pasar de INT_MAX; -1 si no alcanzan
+static int reserve_ids(SharedState *st, int n) {
+    int cur;
+    do {
+        cur = st->next_order_id;
+        if (cur > INT_MAX - n) return -1;
+    } while (!__sync_bool_compare_and_swap(&st->next_order_id, cur, cur + n));
+    return cur;
+}
+
+// Envia las ordenes acumuladas a la cola global (espera si esta llena).
+// Los ids se reservan aqui, solo para el lote que se va a encolar. Si el
+// manager se cierra o no quedan ids, las restantes se descartan y su comando
+// se reporta con ok=false.
+static void batch_push_orders(Batch *bt) {
+    int done = 0;
+    int first = bt->n_orders ? reserve_ids(bt->st, bt->n_orders) : 0;
+    if (first < 0) {
+        for (int i = 0; i < bt->n_orders; ++i) bt->res[bt->order_res[i]].err = "ids de orden agotados";
+        bt->n_orders = 0;
+        return;
+    }
+    for (int i = 0; i < bt->n_orders; ++i) bt->orders[i].id = first + i;
+    while (done < bt->n_orders && !bt->st->shutting_down) {
+        // sin bloquear en sem_wait: el manager no libera espacios al cerrarse
+        int got = queue_push_many(&bt->st->orders, bt->orders + done,
+                                  bt->n_orders - done, MAX_ORDERS, 0);
+        if (got == 0) usleep(1000);
+        done += got;
+    }
+    for (int i = 0; i < bt->n_orders; ++i) {
+        BatchResult *r = &bt->res[bt->order_res[i]];
+        if (i >= done) { r->err = "manager cerrandose"; continue; }
+        if (r->queued++ == 0) r->first_id = bt->orders[i].id;
+        r->last_id = bt->orders[i].id;
+    }
+    bt->n_submitted += done;
+    bt->n_orders = 0;
+}
+
+static void batch_flush(Batch *bt) {
+    SharedState *st = bt->st;
+    if (bt->group == 0) return;
+
+    if (bt->group == 1) {
+        for (int i = 0; i < st->n_bands; ++i) {
+            if (!bt->run_set[i] && !bt->inv_set[i]) continue;
+            BandStatus *b = &st->bands[i];
+            sem_wait(&b->band_mutex);
+            if (bt->run_set[i]) b->running = bt->running[i];
+            for (int k = 0; k < MAX_ING; ++k)
+                if (bt->inv_set[i] & (1u << k)) b->inv[k] = bt->inv[i][k];
+            sem_post(&b->band_mutex);
+        }
+        batch_reset_bands(bt);
+    } else {
+        batch_push_orders(bt);
+    }
+    sem_post(&st->inv_update);
+
+    for (int i = 0; i < bt->n_res; ++i) {
+        const BatchResult *r = &bt->res[i];
+        int ok = 1;
+        if (r->type == CMD_GEN) ok = (r->queued == r->a);
+        else if (r->type == CMD_ORD) ok = (r->queued == 1);
+        printf("{\"line\":%d,\"cmd\":\"%s\",\"ok\":%s", r->line, cmd_name(r->type),
+               ok ? "true" : "false");
+        if (!ok) {
+            printf(",\"error\":\"%s\",\"queued\":%d", r->err ? r->err : "manager cerrandose", r->queued);
+            bt->n_err++;
         } else {
-            printf("Comando no reconocido. Escribe 'help'.\n");
+            bt->n_ok++;
+        }
+        switch (r->type) {
+            case CMD_PAUSE: case CMD_RESUME:
+                printf(",\"band\":%d", r->a); break;
+            case CMD_INV:
+                printf(",\"band\":%d,\"ing\":%d,\"value\":%d", r->a, r->b, r->c); break;
+            case CMD_GEN:
+                printf(",\"first_id\":%d,\"last_id\":%d,\"count\":%d", r->first_id, r->last_id, r->a); break;
+            case CMD_ORD:
+                printf(",\"id\":%d", r->first_id); break;
+            default: break;
         }
+        printf("}\n");
     }
+    bt->n_res = 0;
+    bt->group = 0;
+    fflush(stdout);
+}
+
+static void batch_error(Batch *bt, int line, const char *err) {
+    batch_flush(bt); // preservar el orden de las lineas JSON
+    printf("{\"line\":%d,\"ok\":false,\"error\":\"%s\"}\n", line, err);
+    bt->n_err++;
+}
+
+static void batch_add_order(Batch *bt, const Order *o) {
+    if (bt->n_orders == BATCH_MAX_ORDERS) batch_push_orders(bt);
+    bt->order_res[bt->n_orders] = bt->n_res - 1;
+    bt->orders[bt->n_orders++] = *o;
+}
+
+static void batch_apply(Batch *bt, int line, const Cmd *c) {
+    SharedState *st = bt->st;
+    int group = (c->type == CMD_GEN || c->type == CMD_ORD) ? 2 : 1;
+    if (bt->group != group || bt->n_res == BATCH_MAX_RESULTS) batch_flush(bt);
+    bt->group = group;
+
+    BatchResult *r = &bt->res[bt->n_res++];
+    r->line = line; r->type = c->type;
+    r->a = c->a; r->b = c->b; r->c = c->c;
+    r->first_id = r->last_id = 0;
+    r->queued = 0;
+    r->err = NULL;
+
+    switch (c->type) {
+        case CMD_PAUSE:
+        case CMD_RESUME:
+            bt->running[c->a] = (c->type == CMD_RESUME);
+            bt->run_set[c->a] = 1;
+            break;
+        case CMD_INV:
+            bt->inv[c->a][c->b] = c->c;
+            bt->inv_set[c->a] |= 1u << c->b;
+            break;
+        case CMD_GEN:
+            // los ids se asignan al encolar cada lote (batch_push_orders)
+            for (int i = 0; i < c->a && !st->shutting_down; ++i) {
+                Order o = {0};
+                fill_random_ingredients(&o);
+                batch_add_order(bt, &o);
+            }
+            break;
+        case CMD_ORD: {
+            Order o = {0};
+            for (int k = 0; k < MAX_ING; ++k) o.ing[k] = c->ing[k];
+            batch_add_order(bt, &o);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Lector de lineas propio: permite saber si la siguiente lectura bloquearia
+// (sin linea completa en el buffer y sin datos en el fd), cosa que stdio no
+// expone. Se usa para aplicar el grupo pendiente cuando un pipe queda en silencio.
+typedef struct {
+    int fd;
+    char buf[1 << 16];
+    size_t pos, len;
+    int eof;
+} LineReader;
+
+static int lr_fill(LineReader *lr) {
+    if (lr->pos > 0) {
+        memmove(lr->buf, lr->buf + lr->pos, lr->len - lr->pos);
+        lr->len -= lr->pos; lr->pos = 0;
+    }
+    if (lr->len == sizeof(lr->buf)) return 1;
+    ssize_t r;
+    do r = read(lr->fd, lr->buf + lr->len, sizeof(lr->buf) - lr->len);
+    while (r < 0 && errno == EINTR);
+    if (r <= 0) { lr->eof = 1; return 0; }
+    lr->len += (size_t)r;
+    return 1;
+}
+
+static int lr_would_block(const LineReader *lr) {
+    if (lr->eof || memchr(lr->buf + lr->pos, '\n', lr->len - lr->pos)) return 0;
+    struct pollfd pfd = { lr->fd, POLLIN, 0 };
+    return poll(&pfd, 1, 0) == 0;
+}
+
+// Copia la siguiente linea en out (truncada a cap-1). Devuelve 0 en EOF.
+static int lr_getline(LineReader *lr, char *out, size_t cap) {
+    char *nl;
+    while (!(nl = memchr(lr->buf + lr->pos, '\n', lr->len - lr->pos))) {
+        if (lr->len - lr->pos == sizeof(lr->buf)) break; // linea enorme: cortar
+        if (!lr_fill(lr)) {
+            if (lr->pos == lr->len) return 0;
+            break; // ultima linea sin '\n'
+        }
+    }
+    size_t end = nl ? (size_t)(nl - lr->buf) : lr->len;
+    size_t n = end - lr->pos;
+    if (n > cap - 1) n = cap - 1;
+    memcpy(out, lr->buf + lr->pos, n);
+    out[n] = '\0';
+    lr->pos = nl ? end + 1 : end;
+    return 1;
+}
+
+static void run_batch(SharedState *st, int in_fd) {
+    static char outbuf[1 << 16];
+    setvbuf(stdout, outbuf, _IOFBF, sizeof(outbuf));
+
+    static Batch bt;
+    bt.st = st;
+    batch_reset_bands(&bt);
+
+    static LineReader lr;
+    lr.fd = in_fd;
+
+    char line[256];
+    int lineno = 0;
+    while (!st->shutting_down) {
+        // entrada en pausa (pipe en vivo): aplicar y reportar lo pendiente ya
+        if (bt.group != 0 && lr_would_block(&lr)) batch_flush(&bt);
+        if (!lr_getline(&lr, line, sizeof(line))) break;
+        ++lineno;
+        trim(line);
+        if (line[0] == '#') continue; // comentarios en scripts
+
+        Cmd c;
+        parse_command(line, st, &c);
+        if (c.type == CMD_EMPTY) continue;
+        if (c.type == CMD_QUIT) break;
+        if (c.type == CMD_HELP) { batch_error(&bt, lineno, "help no disponible en modo batch"); continue; }
+        if (c.type == CMD_BAD) { batch_error(&bt, lineno, c.err); continue; }
+        batch_apply(&bt, lineno, &c);
+    }
+    batch_flush(&bt);
+
+    printf("{\"done\":true,\"lines\":%d,\"ok\":%ld,\"errors\":%ld,\"orders\":%ld}\n",
+           lineno, bt.n_ok, bt.n_err, bt.n_submitted);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    int batch = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "b")) != -1) {
+        switch (opt) {
+            case 'b': batch = 1; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    FILE *in = stdin;
+    if (optind < argc) {
+        if (strcmp(argv[optind], "-") != 0) {
+            in = fopen(argv[optind], "r");
+            if (!in) { perror(argv[optind]); return 1; }
+        }
+        batch = 1;
+    }
+
+    // Abrir shm creada por manager
+    int fd = shm_open(SHM_NAME, O_RDWR, 0600);
+    if (fd < 0) { perror("shm_open"); return 1; }
+    SharedState *st = mmap(NULL, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (st == MAP_FAILED) { perror("mmap"); return 1; }
+    close(fd);
+
+    if (batch) run_batch(st, fileno(in));
+    else run_interactive(st);
+
+    if (in != stdin) fclose(in);
     return 0;
 }
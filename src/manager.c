@@ -75,28 +75,12 @@ int main(int argc, char **argv) {
                 }
                 seed = (unsigned)ul; break;
             }
-            case 'i': {
-                // permitir separadores coma y/o espacio
-                int vals[MAX_ING]; int cnt = 0;
-                char tmp[128];
-                strncpy(tmp, optarg, sizeof(tmp)-1); tmp[sizeof(tmp)-1] = '\0';
-                char *tok = strtok(tmp, ", ");
-                while (tok && cnt < MAX_ING) {
-                    char *end = NULL; errno = 0; long v = strtol(tok, &end, 10);
-                    if (errno || end == tok || *end != '\0' || v < 0) {
-                        fprintf(stderr, "Error: -i valores enteros >=0. Ej: -i 10,8,5,6,7,9\n");
-                        usage(argv[0]); return 1;
-                    }
-                    vals[cnt++] = (int)v;
-                    tok = strtok(NULL, ", ");
-                }
-                if (cnt != MAX_ING) {
-                    fprintf(stderr, "Error: -i requiere %d valores\n", MAX_ING);
+            case 'i':
+                if (parse_inventory(optarg, initial_inv) != 0) {
+                    fprintf(stderr, "Error: -i requiere %d valores enteros >=0. Ej: -i 10,8,5,6,7,9\n", MAX_ING);
                     usage(argv[0]); return 1;
                 }
-                for (int k=0;k<MAX_ING;++k) initial_inv[k]=vals[k];
                 break;
-            }
             default: usage(argv[0]); return 1;
         }
     }
@@ -110,25 +94,9 @@ int main(int argc, char **argv) {
     SharedState *st = mmap(NULL, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
     if (st == MAP_FAILED) { perror("mmap"); return 1; }
     close(fd);
-    memset(st, 0, sizeof(*st));
-    st->n_bands = n;
-    st->shutting_down = 0;
-    st->next_order_id = 1;
-    queue_init(&st->orders, MAX_ORDERS);
-    sem_init(&st->inv_update, 1, 0);
-
-    for (int i = 0; i < n; ++i) {
-        BandStatus *b = &st->bands[i];
-        b->id = i;
-        b->running = 1;
-        b->processed = 0;
-        b->busy = 0;
-        // inventario inicial (configurable con -i)
-        for (int k = 0; k < MAX_ING; ++k) b->inv[k] = initial_inv[k];
-        bqueue_init(&b->q, MAX_PER_BAND_QUEUE);
-        sem_init(&b->band_mutex, 1, 1);
-        spawn_worker(st, i);
-    }
+    // inventario inicial (configurable con -i)
+    state_init(st, n, initial_inv, 1);
+    for (int i = 0; i < n; ++i) spawn_worker(st, i);
 
     // inventario manual: no activar restocker automático
 
@@ -139,6 +107,7 @@ int main(int argc, char **argv) {
     fprintf(stderr, "Manager iniciado con %d bandas. Use ./dashboard y ./controller en otras terminales. Presione Ctrl+C para salir.\n", n);
 
     while (!stop_flag) {
+        __sync_fetch_and_add(&st->dispatch_loops, 1);
         // 1) intake: generar automático solo si -g
     if (gen) {
             Order o;
@@ -151,78 +120,11 @@ int main(int argc, char **argv) {
         }
 
         // 2) intentar despachar desde cola global a alguna banda
-        Order cur;
-        int processed_orders = 0;
-        while (queue_pop(&st->orders, &cur, MAX_ORDERS, 0) == 0) {
-            int assigned = 0;
-            
-            // Estrategia: buscar la banda con menos carga primero
-            int best_band = -1;
-            int min_queue = MAX_PER_BAND_QUEUE + 1;
-            
-            for (int i = 0; i < st->n_bands; ++i) {
-                BandStatus *b = &st->bands[i];
-                if (!b->running) continue; // banda pausada
-                
-                // Verificar inventario
-                if (!can_band_fulfill_locked(b, &cur)) continue;
-                
-                // Encontrar banda con menor cola
-                sem_wait(&b->q.mutex);
-                int queue_size = b->q.count;
-                sem_post(&b->q.mutex);
-                
-                if (queue_size < min_queue) {
-                    min_queue = queue_size;
-                    best_band = i;
-                }
-            }
-            
-            if (best_band >= 0) {
-                BandStatus *b = &st->bands[best_band];
-                if (bqueue_push(&b->q, &cur, MAX_PER_BAND_QUEUE, 0) == 0) {
-                    assigned = 1;
-                    processed_orders++;
-                    // Limpiar alerta cuando se asigna exitosamente
-                    if (processed_orders == 1) {
-                        st->last_alert[0] = '\0';
-                    }
-                }
-            }
-            
-            if (!assigned) {
-                // no hay banda con inventario: re-encolar y alertar
-                queue_push(&st->orders, &cur, MAX_ORDERS, 1);
-                // detectar ingrediente faltante más significativo
-                int missingIdx = -1;
-                for (int k = 0; k < MAX_ING; ++k) {
-                    if (cur.ing[k] == 0) continue;
-                    int any = 0;
-                    for (int i = 0; i < st->n_bands; ++i) {
-                        BandStatus *b = &st->bands[i];
-                        sem_wait(&b->band_mutex);
-                        int has_ingredient = (b->inv[k] > 0);
-                        sem_post(&b->band_mutex);
-                        if (has_ingredient) { any = 1; break; }
-                    }
-                    if (!any) { missingIdx = k; break; }
-                }
-                if (missingIdx >= 0)
-                    snprintf(st->last_alert, sizeof(st->last_alert),
-                             "Orden %d bloqueada: falta %s en todas las bandas", cur.id, ING_NAMES[missingIdx]);
-                else
-                    snprintf(st->last_alert, sizeof(st->last_alert),
-                             "Orden %d en espera: bandas ocupadas o sin inventario suficiente", cur.id);
-                // notificar a dashboard
-                sem_post(&st->inv_update);
-                break; // esperar restock o que se liberen bandas
-            }
-        }
-        
-        // Si procesamos órdenes, notificar dashboard
-        if (processed_orders > 0) {
-            sem_post(&st->inv_update);
-        }
+        int blocked = 0;
+        int processed_orders = dispatch_pending(st, &blocked);
+        // notificar a dashboard
+        if (blocked) sem_post(&st->inv_update);
+        if (processed_orders > 0) sem_post(&st->inv_update);
     }
 
     // shutdown
@@ -235,11 +137,7 @@ int main(int argc, char **argv) {
     while (waitpid(-1, NULL, 0) > 0) {}
 
     // limpieza
-    for (int i = 0; i < st->n_bands; ++i) {
-        bqueue_destroy(&st->bands[i].q);
-        sem_destroy(&st->bands[i].band_mutex);
-    }
-    queue_destroy(&st->orders);
+    state_destroy(st);
     munmap(st, sizeof(SharedState));
     shm_unlink(SHM_NAME);
     return 0;
@@ -265,18 +163,14 @@ static void worker_loop(SharedState *st, int idx) {
             usleep(100000);
         }
         if (st->shutting_down) break;
-        if (!can_band_fulfill_locked(b, &o)) {
-            // no alcanza inventario: devolver a global y alertar
-            queue_push(&st->orders, &o, MAX_ORDERS, 1);
-            snprintf(st->last_alert, sizeof(st->last_alert),
-                     "Banda %d sin ingredientes para orden %d", b->id, o.id);
+        if (!band_claim_order(st, b, &o, 1)) {
+            // no alcanza inventario: se devolvió a la cola global con alerta
             sem_post(&st->inv_update);
             sem_wait(&b->band_mutex);
             b->busy = 0;
             sem_post(&b->band_mutex);
             continue;
         }
-        consume_inventory_locked(b, &o);
         // simular preparación
         usleep(300000); // 300ms
         sem_wait(&b->band_mutex);
@@ -0,0 +1,238 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <signal.h>
+#include <string.h>
+#include <errno.h>
+#include "../include/common.h"
+
+// Exportador de métricas en formato de texto Prometheus.
+// Mapea la shm en solo lectura y nunca toma band_mutex ni los mutex de las
+// colas: los valores son lecturas sueltas (pueden estar desfasadas entre sí
+// por unos instantes, lo cual es aceptable para scraping periódico).
+
+#define DEFAULT_PORT 9464
+#define OUT_SIZE 65536
+#define CLIENT_TIMEOUT_MS 1000     // un cliente lento no bloquea a los demás
+
+#define LOAD(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+
+static volatile sig_atomic_t stop_flag = 0;
+static void on_sigint(int sig) { (void)sig; stop_flag = 1; }
+
+static char out[OUT_SIZE];
+static size_t out_len;
+
+static void emit(const char *fmt, ...) {
+    if (out_len >= sizeof(out)) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(out + out_len, sizeof(out) - out_len, fmt, ap);
+    va_end(ap);
+    if (n > 0) out_len += (size_t)n;
+    if (out_len > sizeof(out)) out_len = sizeof(out);
+}
+
+static void header(const char *name, const char *type, const char *help) {
+    emit("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void render(const SharedState *st) {
+    out_len = 0;
+    int n = LOAD(st->n_bands);
+    if (n < 0) n = 0;
+    if (n > MAX_BANDS) n = MAX_BANDS;
+
+    header("burger_bands", "gauge", "Numero de bandas configuradas");
+    emit("burger_bands %d\n", n);
+    header("burger_shutting_down", "gauge", "1 si el manager se esta cerrando");
+    emit("burger_shutting_down %d\n", LOAD(st->shutting_down));
+    header("burger_orders_created_total", "counter", "Ordenes creadas (ids asignados)");
+    emit("burger_orders_created_total %d\n", LOAD(st->next_order_id) - 1);
+    header("burger_global_queue_depth", "gauge", "Ordenes pendientes en la cola global");
+    emit("burger_global_queue_depth %d\n", LOAD(st->orders.count));
+    header("burger_global_queue_capacity", "gauge", "Capacidad de la cola global");
+    emit("burger_global_queue_capacity %d\n", MAX_ORDERS);
+    header("burger_dispatch_loop_iterations_total", "counter", "Iteraciones del bucle de despacho");
+    emit("burger_dispatch_loop_iterations_total %lu\n", LOAD(st->dispatch_loops));
+    header("burger_orders_dispatched_total", "counter", "Ordenes asignadas a una banda");
+    emit("burger_orders_dispatched_total %lu\n", LOAD(st->orders_dispatched));
+    header("burger_dispatch_blocked", "gauge", "1 si el despacho esta detenido por una orden no asignable");
+    emit("burger_dispatch_blocked %d\n", LOAD(st->dispatch_blocked));
+    header("burger_dispatch_blocked_total", "counter", "Veces que el despacho paso de fluir a bloqueado, por causa");
+    emit("burger_dispatch_blocked_total{reason=\"missing_ingredient\"} %lu\n", LOAD(st->blocked_missing));
+    emit("burger_dispatch_blocked_total{reason=\"no_band_available\"} %lu\n", LOAD(st->blocked_waiting));
+    header("burger_orders_returned_total", "counter", "Ordenes devueltas por una banda a la cola global");
+    emit("burger_orders_returned_total %lu\n", LOAD(st->orders_returned));
+    header("burger_alerts_raised_total", "counter", "Alertas nuevas (los reintentos de la misma alerta no cuentan)");
+    emit("burger_alerts_raised_total %lu\n", LOAD(st->alerts_raised));
+    header("burger_alert_active", "gauge", "1 si hay una alerta visible en el dashboard");
+    emit("burger_alert_active %d\n", LOAD(st->last_alert[0]) ? 1 : 0);
+
+    header("burger_band_running", "gauge", "1 si la banda esta activa, 0 si pausada");
+    for (int i = 0; i < n; ++i) emit("burger_band_running{band=\"%d\"} %d\n", i, LOAD(st->bands[i].running));
+    header("burger_band_busy", "gauge", "1 si la banda esta preparando una orden");
+    for (int i = 0; i < n; ++i) emit("burger_band_busy{band=\"%d\"} %d\n", i, LOAD(st->bands[i].busy));
+    header("burger_band_processed_total", "counter", "Hamburguesas completadas por banda");
+    for (int i = 0; i < n; ++i) emit("burger_band_processed_total{band=\"%d\"} %d\n", i, LOAD(st->bands[i].processed));
+    header("burger_band_queue_depth", "gauge", "Ordenes en la cola de la banda");
+    for (int i = 0; i < n; ++i) emit("burger_band_queue_depth{band=\"%d\"} %d\n", i, LOAD(st->bands[i].q.count));
+    header("burger_band_inventory", "gauge", "Inventario actual por banda e ingrediente");
+    for (int i = 0; i < n; ++i)
+        for (int k = 0; k < MAX_ING; ++k)
+            emit("burger_band_inventory{band=\"%d\",ingredient=\"%s\"} %d\n",
+                 i, ING_NAMES[k], LOAD(st->bands[i].inv[k]));
+}
+
+static int write_all(int fd, const char *p, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(fd, p, len);
+        if (w < 0) { if (errno == EINTR) continue; return -1; }
+        p += w; len -= (size_t)w;
+    }
+    return 0;
+}
+
+// 1 si la linea de peticion es GET de exactamente path (seguido de ' ' o '?')
+static int request_is(const char *req, const char *path) {
+    size_t n = strlen(path);
+    if (strncmp(req, "GET ", 4) != 0 || strncmp(req + 4, path, n) != 0) return 0;
+    return req[4 + n] == ' ' || req[4 + n] == '?';
+}
+
+// Atiende una conexion HTTP/1.0: GET /metrics (o /) devuelve el texto
+static void serve_client(int cfd, const SharedState *st) {
+    // leer hasta tener la linea de peticion completa (o hasta el timeout)
+    char req[1024];
+    size_t len = 0;
+    req[0] = '\0';
+    while (len < sizeof(req) - 1 && !strstr(req, "\r\n")) {
+        ssize_t r = read(cfd, req + len, sizeof(req) - 1 - len);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        len += (size_t)r;
+        req[len] = '\0';
+    }
+    if (!strstr(req, "\r\n")) return;
+
+    char hdr[256];
+    if (request_is(req, "/metrics") || request_is(req, "/")) {
+        render(st);
+        int h = snprintf(hdr, sizeof(hdr),
+                         "HTTP/1.0 200 OK\r\n"
+                         "Content-Type: text/plain; version=0.0.4\r\n"
+                         "Content-Length: %zu\r\n"
+                         "Connection: close\r\n\r\n", out_len);
+        if (write_all(cfd, hdr, (size_t)h) == 0) write_all(cfd, out, out_len);
+    } else {
+        const char *nf = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        write_all(cfd, nf, strlen(nf));
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [-p puerto] [-u ruta_socket]\n", prog);
+    fprintf(stderr, "  -p puerto  Puerto HTTP en 127.0.0.1 (por defecto %d)\n", DEFAULT_PORT);
+    fprintf(stderr, "  -u ruta    Servir por socket Unix en lugar de TCP\n");
+}
+
+int main(int argc, char **argv) {
+    int port = DEFAULT_PORT;
+    const char *sock_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:u:")) != -1) {
+        switch (opt) {
+            case 'p': {
+                char *end = NULL; errno = 0;
+                long lp = strtol(optarg, &end, 10);
+                if (errno || end == optarg || *end != '\0' || lp < 1 || lp > 65535) {
+                    fprintf(stderr, "Error: -p debe ser entero en [1..65535]\n");
+                    usage(argv[0]); return 1;
+                }
+                port = (int)lp; break;
+            }
+            case 'u': sock_path = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    // Solo lectura: el exportador no puede tocar semáforos ni estado
+    int fd = shm_open(SHM_NAME, O_RDONLY, 0600);
+    if (fd < 0) { perror("shm_open"); return 1; }
+    const SharedState *st = mmap(NULL, sizeof(SharedState), PROT_READ, MAP_SHARED, fd, 0);
+    if (st == MAP_FAILED) { perror("mmap"); return 1; }
+    close(fd);
+
+    struct sigaction sa = {0}; sa.sa_handler = on_sigint;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    int lfd;
+    if (sock_path) {
+        struct sockaddr_un addr = {0};
+        addr.sun_family = AF_UNIX;
+        if (strlen(sock_path) >= sizeof(addr.sun_path)) {
+            fprintf(stderr, "Error: ruta de socket demasiado larga\n");
+            return 1;
+        }
+        strcpy(addr.sun_path, sock_path);
+        lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (lfd < 0) { perror("socket"); return 1; }
+        // solo reemplazar un socket previo; nunca borrar otro tipo de archivo
+        struct stat sb;
+        if (lstat(sock_path, &sb) == 0) {
+            if (!S_ISSOCK(sb.st_mode)) {
+                fprintf(stderr, "Error: %s existe y no es un socket\n", sock_path);
+                return 1;
+            }
+            unlink(sock_path);
+        } else if (errno != ENOENT) {
+            perror(sock_path); return 1;
+        }
+        if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0) { perror("bind"); return 1; }
+    } else {
+        struct sockaddr_in addr = {0};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((unsigned short)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        lfd = socket(AF_INET, SOCK_STREAM, 0);
+        if (lfd < 0) { perror("socket"); return 1; }
+        int one = 1;
+        setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0) { perror("bind"); return 1; }
+    }
+    if (listen(lfd, 16) != 0) { perror("listen"); return 1; }
+
+    if (sock_path) fprintf(stderr, "Metricas en unix:%s (GET /metrics). Ctrl+C para salir.\n", sock_path);
+    else fprintf(stderr, "Metricas en http://127.0.0.1:%d/metrics. Ctrl+C para salir.\n", port);
+
+    while (!stop_flag && !st->shutting_down) {
+        int cfd = accept(lfd, NULL, NULL);
+        if (cfd < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+        struct timeval tv = { CLIENT_TIMEOUT_MS / 1000, (CLIENT_TIMEOUT_MS % 1000) * 1000 };
+        setsockopt(cfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(cfd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        serve_client(cfd, st);
+        close(cfd);
+    }
+
+    close(lfd);
+    if (sock_path) unlink(sock_path);
+    munmap((void *)st, sizeof(SharedState));
+    return 0;
+}
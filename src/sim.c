@@ -0,0 +1,408 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include "../include/common.h"
+
+// Simulador de eventos discretos: ejecuta la cocina completa en tiempo
+// virtual, en un solo hilo, reutilizando el mismo SharedState, las mismas
+// colas y la misma lógica de despacho (dispatch_pending) y de banda
+// (band_claim_order) que el manager. El estado vive en memoria privada
+// (calloc) con semáforos no compartidos entre procesos (pshared=0).
+// Con la misma semilla y parámetros la salida es idéntica.
+
+typedef enum { EV_ARRIVAL, EV_TICK, EV_COMPLETE, EV_RESTOCK, EV_WINDOW } EvType;
+
+typedef struct {
+    int64_t t;                 // tiempo virtual en microsegundos
+    uint64_t seq;              // desempate FIFO entre eventos simultáneos
+    EvType type;
+    int band;                  // solo EV_COMPLETE
+} Event;
+
+typedef struct {
+    Event *ev;
+    size_t n, cap;
+    uint64_t next_seq;
+} EventHeap;
+
+typedef struct {
+    Order cur;                 // orden en preparación o pendiente de devolver
+    int parked;                // 1 si la cola global estaba llena al devolverla
+    int64_t busy_us;           // tiempo total preparando
+} SimBand;
+
+// Histograma logarítmico de latencias (µs): cubetas de ~1% de ancho y
+// tamaño fijo, para que la memoria no dependa de la duración simulada
+#define HIST_BUCKETS 4096
+#define HIST_GROWTH 1.01
+
+typedef struct {
+    uint64_t b[HIST_BUCKETS];
+    uint64_t n;
+    double sum;
+    int64_t max;
+} LatHist;
+
+typedef struct {
+    long arrivals, rejected, completed;
+    unsigned long blocked_base;
+    LatHist lat;
+} Window;
+
+// Tiempos de llegada de las órdenes que siguen en el sistema (id -> t).
+// En cada momento hay a lo sumo MAX_ORDERS + MAX_BANDS*(MAX_PER_BAND_QUEUE+1)
+// órdenes vivas, así que una tabla abierta fija basta.
+#define INFLIGHT_CAP 4096
+_Static_assert(INFLIGHT_CAP >= 2 * (MAX_ORDERS + MAX_BANDS * (MAX_PER_BAND_QUEUE + 1)),
+               "INFLIGHT_CAP demasiado chico");
+
+typedef struct {
+    int id;                    // 0 = libre
+    int64_t t;
+} Inflight;
+
+static uint64_t rng_state;
+
+static uint64_t rng_next(void) {
+    // xorshift64*: determinista e independiente de la libc
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ULL;
+}
+
+static double rng_uniform(void) {
+    return ((rng_next() >> 11) + 1) * (1.0 / 9007199254740992.0); // (0,1]
+}
+
+static int64_t rng_exp_us(int64_t mean_us) {
+    int64_t v = (int64_t)llround(-log(rng_uniform()) * (double)mean_us);
+    return v < 1 ? 1 : v;
+}
+
+static void *xrealloc(void *p, size_t sz) {
+    void *q = realloc(p, sz);
+    if (!q) { perror("realloc"); exit(1); }
+    return q;
+}
+
+static void heap_push(EventHeap *h, int64_t t, EvType type, int band) {
+    if (h->n == h->cap) {
+        h->cap = h->cap ? h->cap * 2 : 64;
+        h->ev = xrealloc(h->ev, h->cap * sizeof(Event));
+    }
+    Event e = { t, h->next_seq++, type, band };
+    size_t i = h->n++;
+    while (i > 0) {
+        size_t p = (i - 1) / 2;
+        Event *pe = &h->ev[p];
+        if (pe->t < e.t || (pe->t == e.t && pe->seq < e.seq)) break;
+        h->ev[i] = *pe;
+        i = p;
+    }
+    h->ev[i] = e;
+}
+
+static Event heap_pop(EventHeap *h) {
+    Event top = h->ev[0];
+    Event last = h->ev[--h->n];
+    size_t i = 0;
+    for (;;) {
+        size_t c = 2 * i + 1;
+        if (c >= h->n) break;
+        if (c + 1 < h->n && (h->ev[c+1].t < h->ev[c].t ||
+            (h->ev[c+1].t == h->ev[c].t && h->ev[c+1].seq < h->ev[c].seq))) c++;
+        if (last.t < h->ev[c].t || (last.t == h->ev[c].t && last.seq < h->ev[c].seq)) break;
+        h->ev[i] = h->ev[c];
+        i = c;
+    }
+    h->ev[i] = last;
+    return top;
+}
+
+static void hist_add(LatHist *h, int64_t v) {
+    int idx = v > 1 ? (int)(log((double)v) / log(HIST_GROWTH)) : 0;
+    if (idx >= HIST_BUCKETS) idx = HIST_BUCKETS - 1;
+    h->b[idx]++;
+    h->n++;
+    h->sum += (double)v;
+    if (v > h->max) h->max = v;
+}
+
+// Percentil p en ms: borde superior de la cubeta (acotado por el máximo real)
+static double hist_pct_ms(const LatHist *h, double p) {
+    if (h->n == 0) return 0.0;
+    uint64_t target = (uint64_t)ceil(p * (double)h->n);
+    if (target == 0) target = 1;
+    uint64_t cum = 0;
+    int idx = 0;
+    for (; idx < HIST_BUCKETS - 1; ++idx) {
+        cum += h->b[idx];
+        if (cum >= target) break;
+    }
+    double v = pow(HIST_GROWTH, idx + 1);
+    if (v > (double)h->max) v = (double)h->max;
+    return v / 1000.0;
+}
+
+static double hist_mean_ms(const LatHist *h) {
+    return h->n ? h->sum / (double)h->n / 1000.0 : 0.0;
+}
+
+static Inflight inflight[INFLIGHT_CAP];
+
+static size_t inflight_slot(int id) {
+    return ((uint32_t)id * 2654435761u) & (INFLIGHT_CAP - 1);
+}
+
+static void inflight_put(int id, int64_t t) {
+    size_t i = inflight_slot(id);
+    while (inflight[i].id != 0) i = (i + 1) & (INFLIGHT_CAP - 1);
+    inflight[i].id = id;
+    inflight[i].t = t;
+}
+
+// Saca la llegada de id de la tabla (borrado con corrimiento hacia atrás)
+static int64_t inflight_take(int id) {
+    size_t i = inflight_slot(id);
+    for (size_t probes = 0; inflight[i].id != id; ++probes) {
+        if (inflight[i].id == 0 || probes == INFLIGHT_CAP) return -1;
+        i = (i + 1) & (INFLIGHT_CAP - 1);
+    }
+    int64_t t = inflight[i].t;
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & (INFLIGHT_CAP - 1);
+        if (inflight[j].id == 0) break;
+        size_t k = inflight_slot(inflight[j].id);
+        // mover j al hueco i si su posición ideal k no está en (i, j]
+        int between = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!between) { inflight[i] = inflight[j]; i = j; }
+    }
+    inflight[i].id = 0;
+    return t;
+}
+
+// Estado global de la simulación
+static SharedState *st;
+static SimBand sb[MAX_BANDS];
+static EventHeap heap;
+static int64_t prep_us;
+static Window win, total;
+
+static void band_try_start(int i, int64_t now) {
+    BandStatus *b = &st->bands[i];
+    SimBand *s = &sb[i];
+    // mismo ciclo que worker_loop, sin esperas reales
+    while (b->running) {
+        if (!s->parked) {
+            if (b->busy) return;
+            if (bqueue_pop(&b->q, &s->cur, MAX_PER_BAND_QUEUE, 0) != 0) return;
+            b->busy = 1;
+        }
+        int r = band_claim_order(st, b, &s->cur, 0);
+        if (r < 0) { s->parked = 1; return; } // cola global llena: reintentar en el próximo tick
+        s->parked = 0;
+        if (r == 1) {
+            heap_push(&heap, now + prep_us, EV_COMPLETE, i);
+            return;
+        }
+        b->busy = 0;
+    }
+}
+
+// Devuelve 0 si se agotaron los ids de orden (no programar más llegadas)
+static int on_arrival(int64_t now) {
+    if (st->next_order_id == INT_MAX) return 0;
+    Order o;
+    o.id = st->next_order_id++;
+    uint64_t bits = rng_next();
+    for (int k = 0; k < MAX_ING; ++k) o.ing[k] = (int)((bits >> k) & 1);
+    o.ing[0] = 1; // pan
+    o.ing[5] = 1; // carne
+
+    win.arrivals++; total.arrivals++;
+    if (queue_push(&st->orders, &o, MAX_ORDERS, 0) != 0) {
+        // el manager real quedaría bloqueado generando: se cuenta como rechazo
+        win.rejected++; total.rejected++;
+    } else {
+        inflight_put(o.id, now);
+    }
+    return 1;
+}
+
+static void on_complete(int i, int64_t now) {
+    BandStatus *b = &st->bands[i];
+    b->processed++;
+    b->busy = 0;
+    sb[i].busy_us += prep_us;
+    int64_t arrived = inflight_take(sb[i].cur.id);
+    if (arrived >= 0) {
+        hist_add(&win.lat, now - arrived);
+        hist_add(&total.lat, now - arrived);
+    }
+    win.completed++; total.completed++;
+    band_try_start(i, now);
+}
+
+static unsigned long blocked_count(void) {
+    return st->blocked_missing + st->blocked_waiting;
+}
+
+static void emit_window(int64_t now, int64_t window_us) {
+    int band_q = 0;
+    for (int i = 0; i < st->n_bands; ++i) band_q += st->bands[i].q.count;
+    printf("%.3f,%ld,%ld,%ld,%.4f,%d,%d,%lu,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+           now / 1e6, win.arrivals, win.rejected, win.completed,
+           window_us > 0 ? win.completed / (window_us / 1e6) : 0.0,
+           st->orders.count, band_q, blocked_count() - win.blocked_base,
+           hist_mean_ms(&win.lat), hist_pct_ms(&win.lat, 0.50), hist_pct_ms(&win.lat, 0.95),
+           hist_pct_ms(&win.lat, 0.99), win.lat.max / 1000.0);
+    win.arrivals = win.rejected = win.completed = 0;
+    memset(&win.lat, 0, sizeof(win.lat));
+    win.blocked_base = blocked_count();
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [-n bands] [-s seed] [-i a,b,c,d,e,f] [-d seg] [-a ms] [-p ms] [-t ms] [-r seg] [-w seg]\n", prog);
+    fprintf(stderr, "  -n N       Numero de bandas (1..%d, por defecto 2)\n", MAX_BANDS);
+    fprintf(stderr, "  -s seed    Semilla RNG (por defecto 1)\n");
+    fprintf(stderr, "  -i lista   Inventario inicial y de reabastecimiento por banda\n");
+    fprintf(stderr, "  -d seg     Duracion simulada en segundos (por defecto 86400)\n");
+    fprintf(stderr, "  -a ms      Media entre llegadas, proceso de Poisson (por defecto 100)\n");
+    fprintf(stderr, "  -p ms      Tiempo de preparacion por orden (por defecto 300)\n");
+    fprintf(stderr, "  -t ms      Periodo del bucle de despacho (por defecto 100)\n");
+    fprintf(stderr, "  -r seg     Reabastecer todas las bandas cada seg (0 = nunca)\n");
+    fprintf(stderr, "  -w seg     Ventana de las curvas CSV (por defecto 3600)\n");
+}
+
+static int parse_num(const char *s, long min, long max, long *out) {
+    char *end = NULL; errno = 0;
+    long v = strtol(s, &end, 10);
+    if (errno || end == s || *end != '\0' || v < min || v > max) return -1;
+    *out = v;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    long n = 2, seed = 1, dur_s = 86400, arr_ms = 100, prep_ms = 300;
+    long tick_ms = 100, restock_s = 0, window_s = 3600;
+    int inv[MAX_ING] = {10,10,10,10,10,10};
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:i:d:a:p:t:r:w:")) != -1) {
+        int bad = 0;
+        switch (opt) {
+            case 'n': bad = parse_num(optarg, 1, MAX_BANDS, &n); break;
+            case 's': bad = parse_num(optarg, 0, 0x7fffffffL, &seed); break;
+            case 'i': bad = parse_inventory(optarg, inv); break;
+            case 'd': bad = parse_num(optarg, 1, 365L * 86400, &dur_s); break;
+            case 'a': bad = parse_num(optarg, 1, 3600000, &arr_ms); break;
+            case 'p': bad = parse_num(optarg, 1, 3600000, &prep_ms); break;
+            case 't': bad = parse_num(optarg, 1, 60000, &tick_ms); break;
+            case 'r': bad = parse_num(optarg, 0, 365L * 86400, &restock_s); break;
+            case 'w': bad = parse_num(optarg, 1, 365L * 86400, &window_s); break;
+            default: usage(argv[0]); return 1;
+        }
+        if (bad) {
+            fprintf(stderr, "Error: valor invalido para -%c: %s\n", opt, optarg);
+            usage(argv[0]); return 1;
+        }
+    }
+
+    // los ids de orden son int: limitar la cantidad esperada de llegadas
+    if ((double)dur_s * 1000.0 / (double)arr_ms > INT_MAX / 2) {
+        fprintf(stderr, "Error: -d/-a generarian mas de %d ordenes; reduzca -d o aumente -a\n", INT_MAX / 2);
+        usage(argv[0]); return 1;
+    }
+
+    st = calloc(1, sizeof(SharedState));
+    if (!st) { perror("calloc"); return 1; }
+    state_init(st, (int)n, inv, 0);
+    rng_state = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)seed * 0xBF58476D1CE4E5B9ULL);
+    if (!rng_state) rng_state = 1;
+
+    const int64_t end_us = (int64_t)dur_s * 1000000;
+    const int64_t arr_us = (int64_t)arr_ms * 1000;
+    const int64_t tick_us = (int64_t)tick_ms * 1000;
+    const int64_t window_us = (int64_t)window_s * 1000000;
+    prep_us = (int64_t)prep_ms * 1000;
+
+    heap_push(&heap, rng_exp_us(arr_us), EV_ARRIVAL, -1);
+    heap_push(&heap, tick_us, EV_TICK, -1);
+    heap_push(&heap, window_us, EV_WINDOW, -1);
+    if (restock_s > 0) heap_push(&heap, (int64_t)restock_s * 1000000, EV_RESTOCK, -1);
+
+    struct timespec w0, w1;
+    clock_gettime(CLOCK_MONOTONIC, &w0);
+
+    printf("t_s,llegadas,rechazadas,completadas,throughput_s,cola_global,cola_bandas,bloqueos,"
+           "lat_media_ms,lat_p50_ms,lat_p95_ms,lat_p99_ms,lat_max_ms\n");
+
+    unsigned long long n_events = 0;
+    int64_t now = 0, last_window = 0;
+    while (heap.n > 0 && heap.ev[0].t <= end_us) {
+        Event e = heap_pop(&heap);
+        now = e.t;
+        n_events++;
+        switch (e.type) {
+            case EV_ARRIVAL:
+                if (on_arrival(now))
+                    heap_push(&heap, now + rng_exp_us(arr_us), EV_ARRIVAL, -1);
+                else
+                    fprintf(stderr, "Aviso: ids de orden agotados en t=%.1f s; sin mas llegadas\n", now / 1e6);
+                break;
+            case EV_TICK: {
+                // una iteración del bucle de despacho del manager
+                int blocked;
+                st->dispatch_loops++;
+                dispatch_pending(st, &blocked);
+                for (int i = 0; i < st->n_bands; ++i) band_try_start(i, now);
+                heap_push(&heap, now + tick_us, EV_TICK, -1);
+                break;
+            }
+            case EV_COMPLETE:
+                on_complete(e.band, now);
+                break;
+            case EV_RESTOCK:
+                for (int i = 0; i < st->n_bands; ++i)
+                    for (int k = 0; k < MAX_ING; ++k) st->bands[i].inv[k] = inv[k];
+                heap_push(&heap, now + (int64_t)restock_s * 1000000, EV_RESTOCK, -1);
+                break;
+            case EV_WINDOW:
+                emit_window(now, now - last_window);
+                last_window = now;
+                heap_push(&heap, now + window_us, EV_WINDOW, -1);
+                break;
+        }
+    }
+    if (last_window < end_us) emit_window(end_us, end_us - last_window);
+    fflush(stdout);
+
+    clock_gettime(CLOCK_MONOTONIC, &w1);
+    double wall = (w1.tv_sec - w0.tv_sec) + (w1.tv_nsec - w0.tv_nsec) / 1e9;
+
+    fprintf(stderr, "Simulados %.1f s (%.2f dias) en %.2f s reales, %llu eventos\n",
+            end_us / 1e6, end_us / 86400e6, wall, n_events);
+    fprintf(stderr, "Bandas: %d | Llegadas: %ld | Rechazadas: %ld | Completadas: %ld | Throughput: %.3f/s\n",
+            st->n_bands, total.arrivals, total.rejected, total.completed, total.completed / (end_us / 1e6));
+    fprintf(stderr, "Latencia ms: p50 %.1f | p95 %.1f | p99 %.1f | max %.1f\n",
+            hist_pct_ms(&total.lat, 0.50), hist_pct_ms(&total.lat, 0.95),
+            hist_pct_ms(&total.lat, 0.99), total.lat.max / 1000.0);
+    fprintf(stderr, "Bloqueos: falta ingrediente %lu | sin banda %lu | devueltas %lu\n",
+            st->blocked_missing, st->blocked_waiting, st->orders_returned);
+    for (int i = 0; i < st->n_bands; ++i)
+        fprintf(stderr, "  B%d  proc %d  utilizacion %.1f%%\n", i, st->bands[i].processed,
+                100.0 * sb[i].busy_us / (double)end_us);
+
+    state_destroy(st);
+    free(st);
+    free(heap.ev);
+    return 0;
+}